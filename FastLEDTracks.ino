@@ -6,6 +6,7 @@
 //  SoftwareSerial for BlueTooth
 //  Fx for LED effects
 //  Track for track system
+//  EEPROM for uploaded tracks
 /*
    Design Criteria:
     Audioreactive : The device must represent the dance music.
@@ -17,6 +18,7 @@
     Minimal : The device must strenously optimize RAM usage.
      PROGMEM for Track - Can expand without using RAM
      See: https://www.arduino.cc/reference/en/language/variables/utilities/progmem/
+     EEPROM for uploaded Track - Read through a small page, PROGMEM Track is the fallback
     Configurable : The code must be highly configurable by #DEFINE.
     Recoverable : The device should be able to recover from mistimings.
     Cheap : The device must be low cost and easy to produce.
@@ -161,6 +163,12 @@ void setup() {
   Print(F("BT:"));
   Println(String(BLUETOOTH_BAUD_RATE));
 
+  if (TrackUseEeprom(true))
+    Print(F("Track: EEPROM"));
+  else Print(F("Track: PROGMEM"));
+  Print(F(", cues = "));
+  Println(String(numSongTracks));
+
   if (fxState == FxState_PlayingTrack)
     trackStart();
   else Println(F("Ready"));
@@ -196,9 +204,8 @@ void FxEventPoll(unsigned long timecode)
     Print(F(" : next @ "));
     Println(String((float)nextMatchedTimecode / (float)1000.0f));*/
 
-    for (int i = 0; i < numSongTracks; i++)
-      if (SongTrack_timecode(i) == matchedTimecode)
-        FxEventProcess(SongTrack_event(i));
+    for (int i = GetFirstTimeCodeMatch(match); i < numSongTracks && SongTrack_timecode(i) == matchedTimecode; i++)
+      FxEventProcess(SongTrack_event(i));
 
     lastMatchedTimecode = timecode;
   }
@@ -267,6 +274,221 @@ static void magicColors(int count, char *colors)
   FastLED_SetPalette(); 
 }
 
+//////////////// Upload Section ////////////////
+// '@' then count (2 bytes, low first), then pages of up to TRACK_PAGE_CUES cues in
+// EEPROM layout, each followed by the 8-bit sum of its first cue index and its bytes,
+// so a page sent for the wrong place fails.
+// The count is echoed as "ok 0 <count>" so the sender can abort if it arrived damaged.
+// After each page the device answers "ok <next cue>" or "re <cue to resend from>",
+// the sender must wait for it, which keeps the 64 byte serial buffers from overflowing.
+// A plain "re 0" means the count was lost, send '@' and the count again.
+// The sender also resends when an answer does not come, the device stays quiet for a lost page.
+// Only the port that sent '@' feeds the upload, the other one is ignored until it ends.
+// Answers go back on that port alone, a follow suit listening on the other must not act on them.
+#define UPLOAD_RESEND_MS 2000   // Partial page or count after this long is asked for again
+#define UPLOAD_SETTLE_MS 100    // Quiet time after a bad page before asking for it again
+#define UPLOAD_ABORT_MS  10000  // No data for this long gives up, the track source before it is kept
+static bool uploading = false;
+static bool uploadWasEeprom = false; // Track source to go back to if the upload fails
+static Stream *uploadPort = NULL;
+static int uploadCount = 0;
+static int uploadReceived = 0;
+static int uploadPageBytes = 0;  // -3 waiting for '@' again, -2 and -1 receiving the count
+static bool uploadSettling = false; // Dropping input after a bad page until the line is quiet
+static unsigned int uploadBytes = 0;
+static unsigned long uploadStart = 0;
+static unsigned long uploadLastByte = 0;
+
+static void uploadPrint(const String &str) { uploadPort->print(str); }
+static void uploadPrintln(const String &str) { uploadPort->println(str); }
+
+static int uploadPageSize()
+{
+  int cues = uploadCount - uploadReceived;
+  if (cues > TRACK_PAGE_CUES) cues = TRACK_PAGE_CUES;
+  return cues * TRACK_EEPROM_CUE_SIZE + 1;
+}
+
+static void uploadReply(bool ok)
+{
+  uploadPrint(ok ? F("ok ") : F("re "));
+  uploadPrint(String(uploadReceived));
+  if (uploadReceived == 0 && uploadPageBytes >= 0)
+  {
+    uploadPrint(F(" "));
+    uploadPrint(String(uploadCount));
+  }
+  uploadPrintln(F(""));
+}
+
+static void uploadBegin(Stream *port)
+{
+  if (fxState == FxState_PlayingTrack)
+    trackStop();
+  uploadWasEeprom = trackFromEeprom;
+  TrackUseEeprom(false);
+  uploading = true;
+  uploadPort = port;
+  uploadCount = 0;
+  uploadReceived = 0;
+  uploadPageBytes = -2;
+  uploadSettling = false;
+  uploadBytes = 1; //The '@'
+  uploadStart = millis();
+  uploadLastByte = uploadStart;
+  uploadPrintln(F("Upload"));
+}
+
+static void uploadEnd()
+{
+  EEPROM.update(2, uploadCount & 0xFF);
+  EEPROM.update(3, uploadCount >> 8);
+  EEPROM.update(4, TrackEepromSum(uploadCount));
+  EEPROM.update(0, TRACK_EEPROM_MAGIC0);
+  EEPROM.update(1, TRACK_EEPROM_MAGIC1);
+  uploading = false;
+
+  unsigned long ms = millis() - uploadStart;
+  uploadReply(true);
+  uploadPrint(F("Uploaded "));
+  uploadPrint(String(uploadCount));
+  uploadPrint(F(" cues, "));
+  uploadPrint(String(uploadBytes));
+  uploadPrint(F(" bytes in "));
+  uploadPrint(String(ms));
+  uploadPrint(F("ms = "));
+  uploadPrint(String(ms ? uploadBytes * 1000UL / ms : 0));
+  uploadPrintln(F(" B/s"));
+  if (!TrackUseEeprom(true))
+    uploadPrintln(F("Upload failed verify, using PROGMEM"));
+}
+
+static void uploadInput(int data)
+{
+  uploadBytes++;
+  uploadLastByte = millis();
+  if (uploadSettling)
+    return;
+  if (uploadPageBytes < 0)
+  {
+    if (uploadPageBytes == -3)
+    {
+      if (data == '@')
+        uploadPageBytes = -2;
+      return;
+    }
+    if (uploadPageBytes == -2)
+      uploadCount = data;
+    else uploadCount |= data << 8;
+    uploadPageBytes++;
+    if (uploadPageBytes < 0)
+      return;
+    if (uploadCount <= 0 || uploadCount > TRACK_EEPROM_MAX_CUES)
+    {
+      uploading = false;
+      uploadPrint(F("Upload bad count, max "));
+      uploadPrintln(String(TRACK_EEPROM_MAX_CUES));
+      TrackUseEeprom(uploadWasEeprom);
+      return;
+    }
+    EEPROM.update(0, 0xFF); //Invalidate until the whole track is in
+    uploadReply(true);
+    return;
+  }
+
+  trackPage[uploadPageBytes++] = (uint8_t)data;
+  int size = uploadPageSize();
+  if (uploadPageBytes < size)
+    return;
+  uploadPageBytes = 0;
+
+  uint8_t sum = 0;
+  for (int i = 0; i < size - 1; i++)
+    sum += trackPage[i];
+  if ((uint8_t)(sum + uploadReceived) != trackPage[size - 1])
+  {
+    uploadSettling = true; //Stray bytes still in flight would shift the resent page, so wait them out
+    return;
+  }
+  int address = TRACK_EEPROM_HEADER + uploadReceived * TRACK_EEPROM_CUE_SIZE;
+  for (int i = 0; i < size - 1; i++)
+    EEPROM.update(address + i, trackPage[i]);
+  uploadReceived += (size - 1) / TRACK_EEPROM_CUE_SIZE;
+  if (uploadReceived >= uploadCount)
+    uploadEnd();
+  else uploadReply(true);
+}
+
+static void uploadPoll()
+{
+  unsigned long idle = millis() - uploadLastByte;
+  if (idle > UPLOAD_ABORT_MS)
+  {
+    uploading = false;
+    uploadPrintln(F("Upload aborted"));
+    TrackUseEeprom(uploadWasEeprom);
+  }
+  else if ((uploadSettling && idle > UPLOAD_SETTLE_MS) || (idle > UPLOAD_RESEND_MS && uploadPageBytes != 0 && uploadPageBytes != -3))
+  {
+    uploadSettling = false;
+    uploadPageBytes = uploadPageBytes < 0 ? -3 : 0;
+    uploadReply(false);
+  }
+}
+
+// Times real FxEventPoll calls for each cue source, once as each cue fires and once
+// between cues, then puts the playback state back. The cue log is muted, Serial would dominate it.
+static void trackBench()
+{
+  bool useEeprom = trackFromEeprom;
+  FxController savedController = fxController;
+  unsigned long savedMatchedTimecode = lastMatchedTimecode;
+  trackSayEnabled = false;
+  for (int source = 0; source < 2; source++)
+  {
+    if (!TrackUseEeprom(source == 1))
+      continue;
+    lastMatchedTimecode = 0;
+    int cues = 0;
+    unsigned long cueUs = 0, holdUs = 0, cuePages = 0, holdPages = 0;
+    for (int i = 0; i < numSongTracks; i++)
+    {
+      unsigned long tc = SongTrack_timecode(i);
+      if (i + 1 < numSongTracks && SongTrack_timecode(i + 1) == tc)
+        continue;
+      unsigned int loads = trackPageLoads;
+      unsigned long start = micros();
+      FxEventPoll(tc);
+      cueUs += micros() - start;
+      cuePages += trackPageLoads - loads;
+
+      loads = trackPageLoads;
+      start = micros();
+      FxEventPoll(tc + 1);
+      holdUs += micros() - start;
+      holdPages += trackPageLoads - loads;
+      cues++;
+    }
+    Print(source == 1 ? F("EEPROM") : F("PROGMEM"));
+    Print(F(" : "));
+    Print(String(cues));
+    Print(F(" cue times, poll on cue "));
+    Print(String((float)cueUs / (float)cues));
+    Print(F("us "));
+    Print(String((float)cuePages / (float)cues));
+    Print(F(" pages, between cues "));
+    Print(String((float)holdUs / (float)cues));
+    Print(F("us "));
+    Print(String((float)holdPages / (float)cues));
+    Println(F(" pages"));
+  }
+  trackSayEnabled = true;
+  fxController = savedController;
+  lastMatchedTimecode = savedMatchedTimecode;
+  TrackUseEeprom(useEeprom);
+}
+//////////////// Upload Section ////////////////
+
 static bool captureText = false;
 static char colorDefinitionStack[16] = {0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0};
 static int colorDefinitionCount = 0;
@@ -288,8 +510,15 @@ static void processCapturedText()
   colorDefinitionCount = 0;
 }
 
-static void processInput(int data)
+static void processInput(int data, Stream *port)
 {
+  if (uploading)
+  {
+    if (port == uploadPort)
+      uploadInput(data);
+    return;
+  }
+
   if (captureText && data != 10 && data != 13)
   {
 //    Print(F("Capturing="));
@@ -316,12 +545,20 @@ static void processInput(int data)
       Println(F("s : Track Stop"));
       Println(F("0-9 : Color"));
       Println(F("!code : Color code"));
+      Println(F("Upload track : TrackUpload tool"));
+      Println(F("Track source : open brace uploaded, close brace PROGMEM"));
+      Println(F("Track bench : hash"));
       Println(F("(q)lava (w)cloud (e)ocean (r)forest (t)rainbow (y)rainbowstripe (u)party (i)heat"));
       break;
 
     case ')': trackStart(); break;
     case '(': trackStop(); break;
 
+    case '@': uploadBegin(port); break;
+    case '{': Println(TrackUseEeprom(true) ? F("Track: EEPROM") : F("No uploaded track")); break;
+    case '}': TrackUseEeprom(false); Println(F("Track: PROGMEM")); break;
+    case '#': trackBench(); break;
+
     case '0': fxController.animatePalette = false; DirectEvent(fx_palette_dark); FastLED_SetPalette(); break;
     case '1': fxController.animatePalette = false; DirectEvent(fx_palette_white); FastLED_SetPalette(); break;
     case '2': fxController.animatePalette = false; DirectEvent(fx_palette_red); FastLED_SetPalette(); break;
@@ -365,9 +602,15 @@ static void processInput(int data)
 void loop()
 {
   while (Serial.available())
-    processInput(Serial.read());
+    processInput(Serial.read(), &Serial);
   while (bluetooth.available())
-    processInput(bluetooth.read());
+    processInput(bluetooth.read(), &bluetooth);
+
+  if (uploading)
+  {
+    uploadPoll();
+    return; //No LED refresh, FastLED.show() blocks interrupts and SoftwareSerial drops bytes
+  }
 
   if (fxState == FxState_PlayingTrack)
     FxEventPoll(GetTime());
@@ -220,6 +220,9 @@ static String FxEventName(int event)
     case fx_palette_lead:    return F("lead");break;    
     case fx_palette_follow:  return F("follow");break;       
 
+    case fx_track_begin: return F("track begin");break;
+    case fx_track_stop:  return F("track stop");break;
+
     case fx_palette_lava: return F("lava");break;
     case fx_palette_cloud: return F("cloud");break;
     case fx_palette_ocean: return F("ocean");break;
@@ -305,6 +308,7 @@ static String FxEventName(int event)
 
     case fx_nothing:return F("nothing");break;
   }
+  return F("unknown"); //Uploaded tracks can hold any byte
 }
 
 enum FxTransitionType
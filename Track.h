@@ -1,8 +1,11 @@
 #if !defined TRACK_DEF
 #define TRACK_DEF
 #include <avr/pgmspace.h> 
+#include <EEPROM.h>
 
+#if !defined LEAD
 #define LEAD      1                // Set 1 for Dance lead, 0 for Dance follow
+#endif
 
 // Main Track set to 'The Game Has Changed'
 #define TRACK_START_DELAY    1800  // Delay time from start until track should truly 'start'
@@ -134,35 +137,145 @@ const unsigned long SongTrack[] PROGMEM =
   205000, fx_palette_dark
 };
 #endif
-const PROGMEM int numSongTracks = sizeof(SongTrack)/(sizeof(unsigned long)*2);
+const PROGMEM int numProgmemTracks = sizeof(SongTrack)/(sizeof(unsigned long)*2);
+
+//////////////// EEPROM Track Section ////////////////
+// An uploaded track replaces SongTrack without a reflash, PROGMEM stays the fallback.
+// Layout: 'T','K', count lo, count hi, checksum, then 4 bytes per cue:
+//  24-bit timecode (low byte first, up to ~4.6 hours) and 8-bit event.
+// Checksum is the 8-bit sum of all cue bytes.
+// Playback reads it through a RAM page of TRACK_PAGE_CUES cues instead of loading it whole.
+#define TRACK_EEPROM_MAGIC0   'T'
+#define TRACK_EEPROM_MAGIC1   'K'
+#define TRACK_EEPROM_HEADER   5
+#define TRACK_EEPROM_CUE_SIZE 4
+#define TRACK_EEPROM_MAX_CUES ((E2END + 1 - TRACK_EEPROM_HEADER) / TRACK_EEPROM_CUE_SIZE)
+#define TRACK_PAGE_CUES       8   // A page upload fits the 64 byte serial buffers
+
+static bool trackFromEeprom = false;
+static int numSongTracks = numProgmemTracks;
+static int trackPageFirst = -1;
+static unsigned int trackPageLoads = 0;
+// Cues as laid out in EEPROM, doubles as the upload page buffer (plus its sum) since uploads play from PROGMEM
+static uint8_t trackPage[TRACK_PAGE_CUES * TRACK_EEPROM_CUE_SIZE + 1];
+
+// Cues are in timecode order. The span from the last matched cue to the next one is cached,
+// so polls between cues read nothing from the track and scans start from the span.
+static int trackSpanMatch = -1;
+static int trackSpanNext = 0;
+static unsigned long trackSpanTimecode = 0;
+static unsigned long trackSpanNextTimecode = 0;
+
+static void TrackPageLoad(int i)
+{
+  int first = i - (i % TRACK_PAGE_CUES);
+  if (first == trackPageFirst)
+    return;
+  int address = TRACK_EEPROM_HEADER + first * TRACK_EEPROM_CUE_SIZE;
+  int cues = numSongTracks - first < TRACK_PAGE_CUES ? numSongTracks - first : TRACK_PAGE_CUES;
+  for (int b = 0; b < cues * TRACK_EEPROM_CUE_SIZE; b++)
+    trackPage[b] = EEPROM.read(address + b);
+  trackPageFirst = first;
+  trackPageLoads++;
+}
+
+static const uint8_t *TrackPageCue(int i)
+{
+  TrackPageLoad(i);
+  return &trackPage[(i - trackPageFirst) * TRACK_EEPROM_CUE_SIZE];
+}
+
+// 8-bit sum of the cue bytes of an uploaded track
+static uint8_t TrackEepromSum(int count)
+{
+  uint8_t sum = 0;
+  for (int a = TRACK_EEPROM_HEADER; a < TRACK_EEPROM_HEADER + count * TRACK_EEPROM_CUE_SIZE; a++)
+    sum += EEPROM.read(a);
+  return sum;
+}
+
+// Number of cues in the uploaded track, 0 if there is none or it fails the checksum
+static int TrackEepromCount()
+{
+  if (EEPROM.read(0) != TRACK_EEPROM_MAGIC0 || EEPROM.read(1) != TRACK_EEPROM_MAGIC1)
+    return 0;
+  int count = EEPROM.read(2) | (EEPROM.read(3) << 8);
+  if (count <= 0 || count > TRACK_EEPROM_MAX_CUES)
+    return 0;
+  return TrackEepromSum(count) == EEPROM.read(4) ? count : 0;
+}
+
+// Select the uploaded track or SongTrack, returns false if the uploaded track is not valid
+static bool TrackUseEeprom(bool useEeprom)
+{
+  int count = useEeprom ? TrackEepromCount() : 0;
+  trackPageFirst = -1;
+  trackSpanMatch = -1;
+  trackFromEeprom = count > 0;
+  numSongTracks = trackFromEeprom ? count : numProgmemTracks;
+  return trackFromEeprom == useEeprom;
+}
+//////////////// EEPROM Track Section ////////////////
+
+static unsigned long SongTrack_timecode(int i) 
+{ 
+  if (trackSpanMatch >= 0 && i == trackSpanMatch) return trackSpanTimecode;
+  if (trackSpanMatch >= 0 && i == trackSpanNext) return trackSpanNextTimecode;
+  if (trackFromEeprom) { const uint8_t *cue = TrackPageCue(i); return (unsigned long)cue[0] | ((unsigned long)cue[1] << 8) | ((unsigned long)cue[2] << 16); }
+  return pgm_read_dword(&(SongTrack[i*2+0])); 
+} 
+static unsigned long SongTrack_event(int i) 
+{  
+  if (trackFromEeprom) return TrackPageCue(i)[3];
+  return pgm_read_dword(&(SongTrack[i*2+1])); 
+}
 
-static unsigned long SongTrack_timecode(int i) { return pgm_read_dword(&(SongTrack[i*2+0])); } 
-static unsigned long SongTrack_event(int i) {  return pgm_read_dword(&(SongTrack[i*2+1])); }
+static int GetNextTimeCodeMatch(int currentMatch) 
+{ 
+  if (currentMatch == trackSpanMatch) return trackSpanNext;
+  unsigned long tc = SongTrack_timecode(currentMatch); 
+  for (int i=currentMatch+1;i<numSongTracks;i++) if (SongTrack_timecode(i) > tc) return i; 
+  return 0; 
+}
+static int GetCurrentTimeCodeMatch(unsigned long timecode) 
+{ 
+  bool forward = trackSpanMatch >= 0 && timecode >= trackSpanTimecode;
+  if (forward && (trackSpanNext <= trackSpanMatch || timecode < trackSpanNextTimecode))
+    return trackSpanMatch;
+  int match = forward ? trackSpanMatch : 0; 
+  trackSpanMatch = -1;
+  for (int i=match;i<numSongTracks;i++) { if (SongTrack_timecode(i) > timecode) break; match = i; } 
+
+  int next = GetNextTimeCodeMatch(match);
+  trackSpanTimecode = SongTrack_timecode(match);
+  trackSpanNextTimecode = SongTrack_timecode(next);
+  trackSpanNext = next;
+  trackSpanMatch = match;
+  return match; 
+}
+// First cue sharing the timecode of a match, the cues to fire run from here while the timecode holds
+static int GetFirstTimeCodeMatch(int match) { unsigned long tc = SongTrack_timecode(match); while (match > 0 && SongTrack_timecode(match-1) == tc) match--; return match; }
 
-static int GetNextTimeCodeMatch(int currentMatch) { unsigned long tc = SongTrack_timecode(currentMatch); for (int i=0;i<numSongTracks;i++) if (SongTrack_timecode(i) > tc) return i; return 0; }
-static int GetCurrentTimeCodeMatch(unsigned long timecode) { int match = 0; for (int i=0;i<numSongTracks;i++) { if (SongTrack_timecode(i) <= timecode) match = i; } return match; }
+static bool trackSayEnabled = true; // Muted while benchmarking
 
 void FxTrackSay(unsigned long timecode, unsigned long matchedTimecode,unsigned long nextMatchedTimecode)
 {
+    if (!trackSayEnabled)
+      return;
     float tc = (float)matchedTimecode / (float)1000.0f;
     Serial.print(tc);
     Serial.print(F(" :"));
-    for (int i=0;i<numSongTracks;i++)
+    int match = GetCurrentTimeCodeMatch(matchedTimecode);
+    for (int i=GetFirstTimeCodeMatch(match);i<numSongTracks && SongTrack_timecode(i) == matchedTimecode;i++)
     {
-      if (SongTrack_timecode(i) == matchedTimecode)
-      {
-        Serial.print(F(" "));
-        Serial.print(FxEventName(SongTrack_event(i)));
-      }
+      Serial.print(F(" "));
+      Serial.print(FxEventName(SongTrack_event(i)));
     }
     Serial.print(F(", next = "));  
-    for (int i=0;i<numSongTracks;i++)
+    for (int i=GetNextTimeCodeMatch(match);i<numSongTracks && SongTrack_timecode(i) == nextMatchedTimecode;i++)
     {
-      if (SongTrack_timecode(i) == nextMatchedTimecode)
-      {
-          Serial.print(F(" "));
-          Serial.print(FxEventName(SongTrack_event(i)));
-      }
+      Serial.print(F(" "));
+      Serial.print(FxEventName(SongTrack_event(i)));
     }
   
     float timeUntil = (float)(nextMatchedTimecode - (float)timecode) / 1000.0f;
@@ -0,0 +1,278 @@
+// TrackPreview : Offline show renderer for FastLEDTracks
+// Purpose is to see a whole SongTrack without flashing a Nano.
+// Runs the sketch's own FxEventPoll and FastLED_SetPalette on the desktop
+// (through the stand-ins in tools/host) and writes a time x LED image.
+/*
+   Build:
+     g++ -O2 -std=c++11 -I../host -o TrackPreview TrackPreview.cpp
+     Add -DLEAD=0 to preview the follow track.
+   Usage:
+     TrackPreview [-o show.ppm] [-s spectrum.ppm] [-p pixelsPerSecond] [-t lengthMs] [-j workers] [-v]
+      -o : Output image, binary PPM (default show.ppm). ffmpeg -i show.ppm show.png to convert.
+      -s : Spectrum image (PPM) stacked above the LEDs, sharing the time axis.
+      -p : Columns per second of track time (default 10, to match the spectrum below).
+      -t : Track length in ms (default last cue timecode).
+      -j : Worker processes (default one per core).
+      -v : Print the cue log (FxTrackSay) as the track plays, forces one worker.
+   Spectrum, same size rule as the sketch notes but without the legend so columns line up:
+     ffmpeg -i "game.m4a" -lavfi showspectrumpic=s=2050x512:legend=0:color=4:scale=lin:stop=8000 gameLd.ppm
+   Image layout:
+     One column per time step, one row per LED (LED 0 at the top).
+     Time is track time as returned by GetTime(). trackStart() begins that clock at
+     TRACK_START_DELAY, so columns before it stay dark as they do on the suit.
+   Timing:
+     The loop refreshes the LEDs every 46ms, so frames are stepped at PREVIEW_FRAME_MS.
+     Between frames the device polls continuously; here polls land on each cue and
+     the millisecond before it, which is all a fast loop can observe.
+   Workers:
+     The sketch keeps its state in globals, so the timeline is split across forked
+     processes writing into a shared image. Each worker seeks to its first column by
+     replaying polls and palette steps without filling LEDs, then renders its span.
+*/
+#include "../../FastLEDTracks.ino"
+
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include <vector>
+
+#define PREVIEW_FRAME_MS 46 // Matches the 'delay to let bluetooth get data' in loop()
+
+struct PreviewImage
+{
+  int width = 0;
+  int height = 0;
+  uint8_t *rgb = NULL;
+};
+
+static int PreviewColumnFrame(int column, int pixelsPerSecond)
+{
+  unsigned long t = (unsigned long)column * 1000UL / pixelsPerSecond;
+  if (t < TRACK_START_DELAY)
+    return -1;
+  return (t - TRACK_START_DELAY) / PREVIEW_FRAME_MS;
+}
+
+static void PreviewPoll(unsigned long from, unsigned long to)
+{
+  for (int i = 0; i < numSongTracks; i++)
+  {
+    unsigned long tc = SongTrack_timecode(i);
+    if (tc <= from || tc > to)
+      continue;
+    if (i > 0 && SongTrack_timecode(i - 1) == tc)
+      continue;
+    if (tc - 1 > from)
+      FxEventPoll(tc - 1);
+    FxEventPoll(tc);
+  }
+  FxEventPoll(to);
+}
+
+static void PreviewFrame(int frame, bool fill)
+{
+  unsigned long t = TRACK_START_DELAY + (unsigned long)frame * PREVIEW_FRAME_MS;
+  if (frame == 0)
+    FxEventPoll(t);
+  else PreviewPoll(t - PREVIEW_FRAME_MS, t);
+
+  if (fill)
+    FastLED_SetPalette();
+  else if (fxController.animatePalette) //Same palette step as FastLED_SetPalette, without the fill
+    fxController.paletteIndex = fxController.paletteIndex + (fxController.paletteSpeed * fxController.paletteDirection);
+}
+
+static void PreviewRender(PreviewImage &image, int rowOffset, int column0, int column1, int pixelsPerSecond)
+{
+  trackStart();
+  int frame = 0;
+  for (int x = column0; x < column1; x++)
+  {
+    int target = PreviewColumnFrame(x, pixelsPerSecond);
+    for (; frame < target; frame++)
+      PreviewFrame(frame, false);
+    if (frame == target)
+    {
+      PreviewFrame(frame, true);
+      frame++;
+    }
+    for (int i = 0; i < NUM_LEDS; i++)
+    {
+      uint8_t *px = &image.rgb[((rowOffset + i) * image.width + x) * 3];
+      px[0] = leds[i].r;
+      px[1] = leds[i].g;
+      px[2] = leds[i].b;
+    }
+  }
+}
+
+static int PreviewReadToken(FILE *f)
+{
+  int c = fgetc(f);
+  while (c == '#' || c == ' ' || c == '\t' || c == '\r' || c == '\n')
+  {
+    if (c == '#')
+      while (c != '\n' && c != EOF)
+        c = fgetc(f);
+    c = fgetc(f);
+  }
+  int value = 0;
+  while (c >= '0' && c <= '9')
+  {
+    value = value * 10 + (c - '0');
+    c = fgetc(f);
+  }
+  return value;
+}
+
+static bool PreviewLoadPPM(const char *path, std::vector<uint8_t> &rgb, int &width, int &height)
+{
+  FILE *f = fopen(path, "rb");
+  if (!f)
+    return false;
+  bool ok = fgetc(f) == 'P' && fgetc(f) == '6';
+  if (ok)
+  {
+    width = PreviewReadToken(f);
+    height = PreviewReadToken(f);
+    ok = PreviewReadToken(f) == 255 && width > 0 && height > 0;
+  }
+  if (ok)
+  {
+    rgb.resize((size_t)width * height * 3);
+    ok = fread(&rgb[0], 1, rgb.size(), f) == rgb.size();
+  }
+  fclose(f);
+  return ok;
+}
+
+static bool PreviewSavePPM(const char *path, const PreviewImage &image)
+{
+  FILE *f = fopen(path, "wb");
+  if (!f)
+    return false;
+  fprintf(f, "P6\n%d %d\n255\n", image.width, image.height);
+  size_t size = (size_t)image.width * image.height * 3;
+  bool ok = fwrite(image.rgb, 1, size, f) == size;
+  return fclose(f) == 0 && ok;
+}
+
+static double PreviewNow()
+{
+  timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec * 1000.0 + ts.tv_nsec / 1000000.0;
+}
+
+int main(int argc, char **argv)
+{
+  const char *outPath = "show.ppm";
+  const char *spectrumPath = NULL;
+  int pixelsPerSecond = 10;
+  unsigned long length = SongTrack_timecode(numSongTracks - 1);
+  int workers = (int)sysconf(_SC_NPROCESSORS_ONLN);
+  bool verbose = false;
+
+  int opt;
+  while ((opt = getopt(argc, argv, "o:s:p:t:j:v")) != -1)
+  {
+    switch (opt)
+    {
+      case 'o': outPath = optarg; break;
+      case 's': spectrumPath = optarg; break;
+      case 'p': pixelsPerSecond = atoi(optarg); break;
+      case 't': length = strtoul(optarg, NULL, 10); break;
+      case 'j': workers = atoi(optarg); break;
+      case 'v': verbose = true; break;
+      default:
+        fprintf(stderr, "usage: %s [-o show.ppm] [-s spectrum.ppm] [-p pixelsPerSecond] [-t lengthMs] [-j workers] [-v]\n", argv[0]);
+        return 2;
+    }
+  }
+  if (pixelsPerSecond <= 0 || length == 0)
+  {
+    fprintf(stderr, "Bad -p or -t\n");
+    return 2;
+  }
+  if (verbose)
+  {
+    hostSerialOut = stdout;
+    workers = 1;
+  }
+
+  std::vector<uint8_t> spectrum;
+  int spectrumWidth = 0, spectrumHeight = 0;
+  if (spectrumPath && !PreviewLoadPPM(spectrumPath, spectrum, spectrumWidth, spectrumHeight))
+  {
+    fprintf(stderr, "Cannot read spectrum %s (binary P6 PPM, maxval 255)\n", spectrumPath);
+    return 1;
+  }
+
+  double start = PreviewNow();
+  int columns = (int)(length * pixelsPerSecond / 1000UL) + 1;
+  PreviewImage image;
+  image.width = columns > spectrumWidth ? columns : spectrumWidth;
+  image.height = spectrumHeight + NUM_LEDS;
+  size_t size = (size_t)image.width * image.height * 3;
+  image.rgb = (uint8_t *)mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+  if (image.rgb == MAP_FAILED)
+  {
+    perror("mmap");
+    return 1;
+  }
+  for (int y = 0; y < spectrumHeight; y++)
+    memcpy(&image.rgb[(size_t)y * image.width * 3], &spectrum[(size_t)y * spectrumWidth * 3], (size_t)spectrumWidth * 3);
+
+  if (workers < 1)
+    workers = 1;
+  if (workers > columns)
+    workers = columns;
+  if (workers == 1)
+    PreviewRender(image, spectrumHeight, 0, columns, pixelsPerSecond);
+  else
+  {
+    std::vector<pid_t> pids;
+    for (int w = 0; w < workers; w++)
+    {
+      int column0 = (int)((long)columns * w / workers);
+      int column1 = (int)((long)columns * (w + 1) / workers);
+      pid_t pid = fork();
+      if (pid == 0)
+      {
+        PreviewRender(image, spectrumHeight, column0, column1, pixelsPerSecond);
+        _exit(0);
+      }
+      if (pid < 0)
+      {
+        perror("fork");
+        return 1;
+      }
+      pids.push_back(pid);
+    }
+    bool failed = false;
+    for (size_t i = 0; i < pids.size(); i++)
+    {
+      int status = 0;
+      if (waitpid(pids[i], &status, 0) < 0 || !WIFEXITED(status) || WEXITSTATUS(status) != 0)
+        failed = true;
+    }
+    if (failed)
+    {
+      fprintf(stderr, "A render worker failed\n");
+      return 1;
+    }
+  }
+  double elapsed = PreviewNow() - start;
+
+  if (!PreviewSavePPM(outPath, image))
+  {
+    fprintf(stderr, "Cannot write %s\n", outPath);
+    return 1;
+  }
+  fprintf(stderr, "%s : %d cues, %.1fs, %dx%d, %d worker(s), rendered in %.1fms\n",
+          outPath, numSongTracks, length / 1000.0, image.width, image.height, workers, elapsed);
+  return 0;
+}
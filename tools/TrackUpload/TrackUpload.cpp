@@ -0,0 +1,289 @@
+// TrackUpload : Streams a SongTrack into a FastLEDTracks device's EEPROM
+// Purpose is to change cues without a reflash.
+// Packs the SongTrack from Track.h into the uploaded track layout and sends it
+// page by page, waiting for the device's "ok"/"re" answer after each page
+// (see the Upload Section in FastLEDTracks.ino).
+/*
+   Build:
+     g++ -O2 -std=c++11 -I../host -o TrackUpload TrackUpload.cpp
+     Add -DLEAD=0 to upload the follow track.
+   Usage:
+     TrackUpload [-b baud] [-w waitMs] port
+      -b : Baud rate (default 9600 for USB Serial, use 38400 for the bluetooth module).
+      -w : Time to let the device boot before uploading (default 3500, USB opens reset the Nano).
+     ex. TrackUpload /dev/ttyUSB0
+     ex. TrackUpload -b 38400 -w 0 /dev/rfcomm0
+   On the device:
+     { plays the uploaded track, } goes back to PROGMEM, # reports the poll cost per cue.
+*/
+#include <Arduino.h>
+#include "../../Fx.h"
+#include "../../Track.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdlib.h>
+#include <string.h>
+#include <termios.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/select.h>
+#include <vector>
+
+#define UPLOAD_REPLY_MS  5000 // Longer than the device's own resend timeout, shorter than its abort
+#define UPLOAD_RETRIES   10
+
+static double UploadNow()
+{
+  timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec * 1000.0 + ts.tv_nsec / 1000000.0;
+}
+
+static speed_t UploadBaud(long baud)
+{
+  switch (baud)
+  {
+    case 9600: return B9600;
+    case 19200: return B19200;
+    case 38400: return B38400;
+    case 57600: return B57600;
+    case 115200: return B115200;
+  }
+  return 0;
+}
+
+static int UploadOpen(const char *path, long baud)
+{
+  speed_t speed = UploadBaud(baud);
+  if (!speed)
+  {
+    fprintf(stderr, "Unsupported baud %ld\n", baud);
+    return -1;
+  }
+  int fd = open(path, O_RDWR | O_NOCTTY);
+  if (fd < 0)
+  {
+    perror(path);
+    return -1;
+  }
+  termios tio;
+  if (tcgetattr(fd, &tio) == 0)
+  {
+    cfmakeraw(&tio);
+    cfsetispeed(&tio, speed);
+    cfsetospeed(&tio, speed);
+    tio.c_cflag |= CLOCAL | CREAD;
+    tcsetattr(fd, TCSANOW, &tio);
+  }
+  return fd;
+}
+
+// Reads one line from the device, false on timeout
+static bool UploadReadLine(int fd, std::string &line, double timeoutMs)
+{
+  line.clear();
+  double end = UploadNow() + timeoutMs;
+  for (;;)
+  {
+    double left = end - UploadNow();
+    if (left <= 0)
+      return false;
+    fd_set set;
+    FD_ZERO(&set);
+    FD_SET(fd, &set);
+    timeval tv;
+    tv.tv_sec = (long)(left / 1000);
+    tv.tv_usec = (long)((left - tv.tv_sec * 1000.0) * 1000);
+    int ready = select(fd + 1, &set, NULL, NULL, &tv);
+    if (ready < 0 && errno == EINTR)
+      continue;
+    if (ready <= 0)
+      return false;
+    char c;
+    if (read(fd, &c, 1) != 1)
+      return false;
+    if (c == '\n')
+      return true;
+    if (c != '\r')
+      line += c;
+  }
+}
+
+static bool UploadWrite(int fd, const uint8_t *data, size_t size)
+{
+  while (size > 0)
+  {
+    ssize_t n = write(fd, data, size);
+    if (n < 0 && errno == EINTR)
+      continue;
+    if (n <= 0)
+      return false;
+    data += n;
+    size -= n;
+  }
+  return tcdrain(fd) == 0;
+}
+
+static bool UploadSendBegin(int fd, int count, size_t &sent)
+{
+  uint8_t begin[3] = { '@', (uint8_t)(count & 0xFF), (uint8_t)(count >> 8) };
+  sent += sizeof(begin);
+  return UploadWrite(fd, begin, sizeof(begin));
+}
+
+// Page of cues from 'cue', followed by the sum of the cue index and the page bytes
+static bool UploadSendPage(int fd, const std::vector<uint8_t> &cues, int cue, size_t &sent)
+{
+  int count = cues.size() / TRACK_EEPROM_CUE_SIZE;
+  int pageCues = count - cue < TRACK_PAGE_CUES ? count - cue : TRACK_PAGE_CUES;
+  std::vector<uint8_t> page(cues.begin() + cue * TRACK_EEPROM_CUE_SIZE, cues.begin() + (cue + pageCues) * TRACK_EEPROM_CUE_SIZE);
+  uint8_t sum = (uint8_t)cue;
+  for (size_t i = 0; i < page.size(); i++)
+    sum += page[i];
+  page.push_back(sum);
+  sent += page.size();
+  return UploadWrite(fd, &page[0], page.size());
+}
+
+static bool UploadPack(std::vector<uint8_t> &cues)
+{
+  if (numProgmemTracks > TRACK_EEPROM_MAX_CUES)
+  {
+    fprintf(stderr, "Track has %d cues, EEPROM holds %d\n", numProgmemTracks, (int)TRACK_EEPROM_MAX_CUES);
+    return false;
+  }
+  for (int i = 0; i < numProgmemTracks; i++)
+  {
+    unsigned long timecode = SongTrack[i * 2 + 0];
+    unsigned long event = SongTrack[i * 2 + 1];
+    if (timecode > 0xFFFFFF || event > 0xFF)
+    {
+      fprintf(stderr, "Cue %d (%lu, %lu) does not fit the uploaded track layout\n", i, timecode, event);
+      return false;
+    }
+    if (FxEventName(event) == String(F("unknown")))
+    {
+      fprintf(stderr, "Cue %d (%lu, %lu) is not a known Fx event\n", i, timecode, event);
+      return false;
+    }
+    cues.push_back(timecode & 0xFF);
+    cues.push_back((timecode >> 8) & 0xFF);
+    cues.push_back((timecode >> 16) & 0xFF);
+    cues.push_back((uint8_t)event);
+  }
+  return true;
+}
+
+int main(int argc, char **argv)
+{
+  long baud = 9600;
+  double waitMs = 3500;
+  int opt;
+  while ((opt = getopt(argc, argv, "b:w:")) != -1)
+  {
+    switch (opt)
+    {
+      case 'b': baud = atol(optarg); break;
+      case 'w': waitMs = atof(optarg); break;
+      default: optind = argc + 1; break;
+    }
+  }
+  if (optind != argc - 1)
+  {
+    fprintf(stderr, "usage: %s [-b baud] [-w waitMs] port\n", argv[0]);
+    return 2;
+  }
+
+  std::vector<uint8_t> cues;
+  if (!UploadPack(cues))
+    return 1;
+  int count = numProgmemTracks;
+
+  int fd = UploadOpen(argv[optind], baud);
+  if (fd < 0)
+    return 1;
+
+  std::string line;
+  double bootEnd = UploadNow() + waitMs;
+  while (UploadNow() < bootEnd)
+    if (UploadReadLine(fd, line, bootEnd - UploadNow()))
+      printf("< %s\n", line.c_str());
+
+  double start = UploadNow();
+  size_t sent = 0;
+  if (!UploadSendBegin(fd, count, sent))
+  {
+    perror("write");
+    return 1;
+  }
+
+  // Until the device echoes the count, every resend is '@' and the count
+  int retries = 0;
+  int cue = 0;
+  bool countEchoed = false;
+  for (;;)
+  {
+    bool written;
+    if (!UploadReadLine(fd, line, UPLOAD_REPLY_MS))
+    {
+      if (++retries > UPLOAD_RETRIES)
+      {
+        fprintf(stderr, "No answer from device\n");
+        return 1;
+      }
+      written = countEchoed ? UploadSendPage(fd, cues, cue, sent) : UploadSendBegin(fd, count, sent);
+    }
+    else
+    {
+      bool ok = line.compare(0, 3, "ok ") == 0;
+      bool resend = line.compare(0, 3, "re ") == 0;
+      if (!ok && !resend)
+      {
+        printf("< %s\n", line.c_str());
+        if (line.compare(0, 6, "Upload") == 0 && line != "Upload")
+          return 1;
+        continue;
+      }
+      char *end = NULL;
+      cue = (int)strtol(line.c_str() + 3, &end, 10);
+      if (cue < 0 || cue > count || (ok && !countEchoed && *end != ' '))
+      {
+        fprintf(stderr, "Bad answer '%s'\n", line.c_str());
+        return 1;
+      }
+      if (*end == ' ')
+      {
+        int echoed = atoi(end + 1);
+        if (cue != 0 || echoed != count)
+        {
+          fprintf(stderr, "Device got count %d, sent %d\n", echoed, count);
+          return 1;
+        }
+        countEchoed = true;
+      }
+      if (ok && cue == count)
+        break;
+      if (resend && ++retries > UPLOAD_RETRIES)
+      {
+        fprintf(stderr, "Too many resends at cue %d\n", cue);
+        return 1;
+      }
+      if (ok)
+        retries = 0;
+      written = countEchoed ? UploadSendPage(fd, cues, cue, sent) : UploadSendBegin(fd, count, sent);
+    }
+    if (!written)
+    {
+      perror("write");
+      return 1;
+    }
+  }
+  double elapsed = UploadNow() - start;
+
+  if (UploadReadLine(fd, line, UPLOAD_REPLY_MS))
+    printf("< %s\n", line.c_str());
+  printf("Sent %d cues, %zu bytes in %.0fms = %.0f B/s\n", count, sent, elapsed, elapsed > 0 ? sent * 1000.0 / elapsed : 0.0);
+  close(fd);
+  return 0;
+}
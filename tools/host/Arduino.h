@@ -0,0 +1,76 @@
+#if !defined HOST_ARDUINO_DEF
+#define HOST_ARDUINO_DEF
+
+/*
+ * Host stand-in for the Arduino core, just enough for the sketch to compile
+ * on a desktop so tools can run the real Fx/Track code.
+ * Serial output is dropped unless hostSerialOut is set; the bluetooth
+ * SoftwareSerial mirrors Serial in the sketch, so it is never echoed.
+ */
+#include <stdint.h>
+#include <stdio.h>
+#include <string>
+#include <chrono>
+
+#define PROGMEM
+class __FlashStringHelper;
+#define F(s) ((const __FlashStringHelper *)(s))
+typedef uint8_t byte;
+
+static unsigned long millis()
+{
+  static auto start = std::chrono::steady_clock::now();
+  return (unsigned long)std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count();
+}
+static unsigned long micros()
+{
+  static auto start = std::chrono::steady_clock::now();
+  return (unsigned long)std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
+}
+static void delay(unsigned long) {}
+
+class String : public std::string
+{
+public:
+  String() {}
+  String(const char *s) : std::string(s) {}
+  String(const __FlashStringHelper *s) : std::string((const char *)s) {}
+  String(const std::string &s) : std::string(s) {}
+  String(char c) : std::string(1, c) {}
+  String(int v) : std::string(std::to_string(v)) {}
+  String(unsigned int v) : std::string(std::to_string(v)) {}
+  String(long v) : std::string(std::to_string(v)) {}
+  String(unsigned long v) : std::string(std::to_string(v)) {}
+  String(double v, int decimals = 2) { char buf[32]; snprintf(buf, sizeof(buf), "%.*f", decimals, v); assign(buf); }
+};
+
+static FILE *hostSerialOut = NULL;
+
+class Stream
+{
+public:
+  Stream(bool echo = true) : echo(echo) {}
+  void print(const String &s) { if (echo && hostSerialOut) fputs(s.c_str(), hostSerialOut); }
+  void print(const char *s) { print(String(s)); }
+  void print(char c) { print(String(c)); }
+  void print(int v) { print(String(v)); }
+  void print(unsigned int v) { print(String(v)); }
+  void print(long v) { print(String(v)); }
+  void print(unsigned long v) { print(String(v)); }
+  void print(double v) { print(String(v)); }
+  template <typename T> void println(T v) { print(v); println(); }
+  void println() { print("\r\n"); }
+  bool echo;
+};
+
+class HostSerial : public Stream
+{
+public:
+  HostSerial(bool echo = true) : Stream(echo) {}
+  void begin(unsigned long) {}
+  int available() { return 0; }
+  int read() { return -1; }
+};
+static HostSerial Serial;
+
+#endif
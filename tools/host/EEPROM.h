@@ -0,0 +1,27 @@
+#if !defined HOST_EEPROM_DEF
+#define HOST_EEPROM_DEF
+
+/*
+ * Host stand-in for the Arduino EEPROM library, sized like the Nano's.
+ * Starts erased (0xFF) so the sketch falls back to the PROGMEM SongTrack.
+ */
+#include "Arduino.h"
+#include <string.h>
+
+#if !defined E2END
+#define E2END 1023
+#endif
+
+class HostEEPROM
+{
+public:
+  HostEEPROM() { memset(data, 0xFF, sizeof(data)); }
+  uint8_t read(int address) { return data[address]; }
+  void write(int address, uint8_t value) { data[address] = value; }
+  void update(int address, uint8_t value) { data[address] = value; }
+  uint16_t length() { return E2END + 1; }
+  uint8_t data[E2END + 1];
+};
+static HostEEPROM EEPROM;
+
+#endif
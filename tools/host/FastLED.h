@@ -0,0 +1,110 @@
+#if !defined HOST_FASTLED_DEF
+#define HOST_FASTLED_DEF
+
+/*
+ * Host stand-in for the parts of FastLED the sketch uses.
+ * Palette lookup follows FastLED's ColorFromPalette so previews match the suit;
+ * brightness and colour correction are applied at show() time on hardware and are left out here.
+ */
+#include "Arduino.h"
+
+struct CRGB
+{
+  union
+  {
+    struct { uint8_t r, g, b; };
+    uint8_t raw[3];
+  };
+  CRGB() : r(0), g(0), b(0) {}
+  CRGB(uint8_t ir, uint8_t ig, uint8_t ib) : r(ir), g(ig), b(ib) {}
+  CRGB(uint32_t colorcode) : r((colorcode >> 16) & 0xFF), g((colorcode >> 8) & 0xFF), b(colorcode & 0xFF) {}
+  uint8_t &operator[](int i) { return raw[i]; }
+  const uint8_t &operator[](int i) const { return raw[i]; }
+};
+
+typedef uint32_t TProgmemRGBPalette16[16];
+
+struct CRGBPalette16
+{
+  CRGB entries[16];
+  CRGBPalette16() {}
+  CRGBPalette16(const CRGB &c00, const CRGB &c01, const CRGB &c02, const CRGB &c03,
+                const CRGB &c04, const CRGB &c05, const CRGB &c06, const CRGB &c07,
+                const CRGB &c08, const CRGB &c09, const CRGB &c10, const CRGB &c11,
+                const CRGB &c12, const CRGB &c13, const CRGB &c14, const CRGB &c15)
+  {
+    entries[0] = c00;  entries[1] = c01;  entries[2] = c02;  entries[3] = c03;
+    entries[4] = c04;  entries[5] = c05;  entries[6] = c06;  entries[7] = c07;
+    entries[8] = c08;  entries[9] = c09;  entries[10] = c10; entries[11] = c11;
+    entries[12] = c12; entries[13] = c13; entries[14] = c14; entries[15] = c15;
+  }
+  CRGBPalette16(const TProgmemRGBPalette16 &rhs) { for (int i = 0; i < 16; i++) entries[i] = CRGB(rhs[i]); }
+  CRGB &operator[](int i) { return entries[i]; }
+  const CRGB &operator[](int i) const { return entries[i]; }
+};
+
+static const TProgmemRGBPalette16 CloudColors_p = {
+  0x0000FF, 0x00008B, 0x00008B, 0x00008B, 0x00008B, 0x00008B, 0x00008B, 0x00008B,
+  0x0000FF, 0x00008B, 0x87CEEB, 0x87CEEB, 0xADD8E6, 0xFFFFFF, 0xADD8E6, 0x87CEEB };
+static const TProgmemRGBPalette16 LavaColors_p = {
+  0x000000, 0x800000, 0x000000, 0x800000, 0x8B0000, 0x8B0000, 0x800000, 0x8B0000,
+  0x8B0000, 0x8B0000, 0xFF0000, 0xFFA500, 0xFFFFFF, 0xFFA500, 0xFF0000, 0x8B0000 };
+static const TProgmemRGBPalette16 OceanColors_p = {
+  0x191970, 0x00008B, 0x191970, 0x000080, 0x00008B, 0x0000CD, 0x2E8B57, 0x008080,
+  0x5F9EA0, 0x0000FF, 0x008B8B, 0x6495ED, 0x7FFFD4, 0x2E8B57, 0x00FFFF, 0x87CEFA };
+static const TProgmemRGBPalette16 ForestColors_p = {
+  0x006400, 0x006400, 0x556B2F, 0x006400, 0x008000, 0x228B22, 0x6B8E23, 0x008000,
+  0x2E8B57, 0x66CDAA, 0x32CD32, 0x9ACD32, 0x90EE90, 0x7CFC00, 0x66CDAA, 0x228B22 };
+static const TProgmemRGBPalette16 RainbowColors_p = {
+  0xFF0000, 0xD52A00, 0xAB5500, 0xAB7F00, 0xABAB00, 0x56D500, 0x00FF00, 0x00D52A,
+  0x00AB55, 0x0056AA, 0x0000FF, 0x2A00D5, 0x5500AB, 0x7F0081, 0xAB0055, 0xD5002B };
+static const TProgmemRGBPalette16 RainbowStripeColors_p = {
+  0xFF0000, 0x000000, 0xAB5500, 0x000000, 0xABAB00, 0x000000, 0x00FF00, 0x000000,
+  0x00AB55, 0x000000, 0x0000FF, 0x000000, 0x5500AB, 0x000000, 0xAB0055, 0x000000 };
+static const TProgmemRGBPalette16 PartyColors_p = {
+  0x5500AB, 0x84007C, 0xB5004B, 0xE5001B, 0xE81700, 0xB84700, 0xAB7700, 0xABAB00,
+  0xAB5500, 0xDD2200, 0xF2000E, 0xC2003E, 0x8F0071, 0x5F00A1, 0x2F00D0, 0x0007F9 };
+static const TProgmemRGBPalette16 HeatColors_p = {
+  0x000000, 0x330000, 0x660000, 0x990000, 0xCC0000, 0xFF0000, 0xFF3300, 0xFF6600,
+  0xFF9900, 0xFFCC00, 0xFFFF00, 0xFFFF33, 0xFFFF66, 0xFFFF99, 0xFFFFCC, 0xFFFFFF };
+
+enum TBlendType { NOBLEND = 0, LINEARBLEND = 1 };
+
+static uint8_t scale8(uint8_t i, uint8_t scale) { return (uint8_t)(((uint16_t)i * (1 + (uint16_t)scale)) >> 8); }
+
+static CRGB ColorFromPalette(const CRGBPalette16 &pal, uint8_t index, uint8_t brightness, TBlendType blendType)
+{
+  uint8_t hi4 = index >> 4;
+  uint8_t lo4 = index & 0x0F;
+  CRGB c = pal[hi4];
+  if (lo4 && blendType != NOBLEND)
+  {
+    const CRGB &n = pal[(hi4 + 1) & 0x0F];
+    uint8_t f2 = lo4 << 4;
+    uint8_t f1 = 255 - f2;
+    c = CRGB(scale8(c.r, f1) + scale8(n.r, f2), scale8(c.g, f1) + scale8(n.g, f2), scale8(c.b, f1) + scale8(n.b, f2));
+  }
+  if (brightness != 255)
+    c = CRGB(scale8(c.r, brightness), scale8(c.g, brightness), scale8(c.b, brightness));
+  return c;
+}
+
+enum { WS2811, WS2812B };
+enum { RGB, GRB };
+static const uint32_t TypicalLEDStrip = 0xFFB0F0;
+
+struct HostLEDController
+{
+  HostLEDController &setCorrection(uint32_t) { return *this; }
+};
+
+struct HostFastLED
+{
+  template <int CHIPSET, int DATA_PIN, int RGB_ORDER> HostLEDController &addLeds(CRGB *, int) { return controller; }
+  void setBrightness(uint8_t) {}
+  void show() {}
+  HostLEDController controller;
+};
+static HostFastLED FastLED;
+
+#endif
@@ -0,0 +1,12 @@
+#if !defined HOST_SOFTWARESERIAL_DEF
+#define HOST_SOFTWARESERIAL_DEF
+
+#include "Arduino.h"
+
+class SoftwareSerial : public HostSerial
+{
+public:
+  SoftwareSerial(int rxPin, int txPin) : HostSerial(false) {}
+};
+
+#endif
@@ -0,0 +1,8 @@
+#if !defined HOST_PGMSPACE_DEF
+#define HOST_PGMSPACE_DEF
+
+// Host memory is flat, so program-space reads are plain reads.
+#define pgm_read_byte(addr)  (*(addr))
+#define pgm_read_dword(addr) (*(addr))
+
+#endif